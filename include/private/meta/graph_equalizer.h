@@ -51,6 +51,11 @@ namespace lsp
             static constexpr float          REACT_TIME_DFL      = 0.200f;
             static constexpr float          REACT_TIME_STEP     = 0.001f;
 
+            static constexpr float          LTAVG_TIME_MIN      = 1.000f;
+            static constexpr float          LTAVG_TIME_MAX      = 60.000f;
+            static constexpr float          LTAVG_TIME_DFL      = 10.000f;
+            static constexpr float          LTAVG_TIME_STEP     = 0.001f;
+
             static constexpr float          BAND_GAIN_MIN       = GAIN_AMP_M_36_DB;
             static constexpr float          BAND_GAIN_MAX       = GAIN_AMP_P_36_DB;
             static constexpr float          BAND_GAIN_DFL       = GAIN_AMP_0_DB;
@@ -75,6 +80,13 @@ namespace lsp
                 PEM_SPM
             };
 
+            enum spectrum_view_t
+            {
+                SV_REALTIME,
+                SV_AVERAGE,
+                SV_PEAK_HOLD
+            };
+
             static const float band_frequencies[];
         };
 
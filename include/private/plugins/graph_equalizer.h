@@ -22,6 +22,7 @@
 #ifndef PRIVATE_PLUGINS_GRAPH_EQUALIZER_H_
 #define PRIVATE_PLUGINS_GRAPH_EQUALIZER_H_
 
+#include <lsp-plug.in/ipc/ITask.h>
 #include <lsp-plug.in/plug-fw/plug.h>
 #include <lsp-plug.in/plug-fw/core/IDBuffer.h>
 #include <lsp-plug.in/dsp-units/ctl/Bypass.h>
@@ -67,8 +68,7 @@ namespace lsp
                 {
                     bool                bSolo;          // Solo
                     uint32_t            nSync;          // Chart state
-                    float              *vTrRe;          // Transfer function (real part)
-                    float              *vTrIm;          // Transfer function (imaginary part)
+                    float              *vTrAmp;         // Amplitude of the transfer function
 
                     plug::IPort        *pGain;          // Gain port
                     plug::IPort        *pSolo;          // Solo port
@@ -79,9 +79,13 @@ namespace lsp
 
                 typedef struct eq_channel_t
                 {
-                    dspu::Equalizer     sEqualizer;     // Equalizer
+                    dspu::Equalizer     sIirEqualizer;  // Equalizer supporting IIR mode only
+                    dspu::Equalizer     sEqualizer;     // Equalizer supporting all modes, initialized on demand
+                    dspu::Equalizer    *pEqualizer;     // Active equalizer
                     dspu::Bypass        sBypass;        // Bypass
-                    dspu::Delay         sDryDelay;      // Dry delay
+                    dspu::Delay         sDryDelay;      // Dry delay for the IIR-only equalizer
+                    dspu::Delay         sFirDryDelay;   // Dry delay for the equalizer supporting all modes, initialized on demand
+                    dspu::Delay        *pDryDelay;      // Active dry delay
 
                     uint32_t            nSync;          // Chart state
                     float               fInGain;        // Input gain
@@ -98,8 +102,11 @@ namespace lsp
                     float              *vOutBuffer;     // Output buffer
                     float              *vExtBuffer;     // External (send) buffer
 
-                    float              *vTrRe;          // Transfer function (real part)
-                    float              *vTrIm;          // Transfer function (imaginary part)
+                    float              *vTrAmp;         // Amplitude of the transfer function
+
+                    bool                bFftOn[3];      // Spectrum analysis enable flags (input, output, return)
+                    uint32_t            nFftFrames[3];  // Number of spectrum frames accumulated since last reset (input, output, return)
+                    float              *vFftAcc[3];     // Long-term spectrum accumulators (input, output, return)
 
                     plug::IPort        *pIn;            // Input port
                     plug::IPort        *pOut;           // Output port
@@ -118,10 +125,92 @@ namespace lsp
                     plug::IPort        *pOutMeter;      // Output level meter
                 } eq_channel_t;
 
+                typedef struct idisplay_t
+                {
+                    size_t              nWidth;         // Width of the cached image
+                    size_t              nHeight;        // Height of the cached image
+                    float               fZoom;          // Zoom of the cached image
+                    uint32_t            nSerial;        // Serial number of the cached transfer functions
+                    size_t              nVLines;        // Number of vertical grid lines
+                    size_t              nHLines;        // Number of horizontal grid lines
+                    float               vVLines[4];     // Positions of vertical grid lines
+                    float               vHLines[10];    // Positions of horizontal grid lines
+                } idisplay_t;
+
+                class FirLoader: public ipc::ITask
+                {
+                    private:
+                        graph_equalizer    *pCore;
+
+                    public:
+                        explicit FirLoader(graph_equalizer *core);
+                        virtual ~FirLoader() override;
+
+                    public:
+                        virtual status_t    run() override;
+                };
+
+            #ifdef LSP_TIMING
+                enum profile_stage_t
+                {
+                    PS_PRE_PROCESS,                     // Dry delay, input gain, M/S conversion, input metering
+                    PS_EQUALIZER,                       // Equalizer processing
+                    PS_ANALYSIS,                        // Spectrum analysis
+                    PS_POST_PROCESS,                    // M/S conversion, output metering, send, bypass
+                    PS_MESH_SYNC,                       // Spectrum and transfer function mesh synchronization
+
+                    PS_TOTAL
+                };
+
+                typedef struct profiler_t
+                {
+                    uint32_t            nCalls;                 // Number of measured process() calls
+                    float               vTime[PS_TOTAL];        // Time spent by each stage in current process() call, us
+                    float               vMean[PS_TOTAL];        // Rolling mean time of each stage, us
+                    float               vMax[PS_TOTAL];         // Rolling maximum time of each stage, us
+                } profiler_t;
+
+                enum latency_limits_t
+                {
+                    LH_BINS             = 200,                  // Number of histogram bins, covers 0..200% of the deadline
+                    LH_RING             = 256                   // Number of recent measurements kept
+                };
+
+                typedef struct latency_sample_t
+                {
+                    float               fLoad;                  // Duration of the process() call relative to the deadline
+                    uint32_t            nConfig;                // Configuration key at the moment of measurement
+                } latency_sample_t;
+
+                typedef struct latency_t
+                {
+                    uint32_t            nConfig;                // Current configuration key: (equalizer mode << 16) | slope
+                    uint32_t            nHead;                  // Ring head, published by the audio thread
+                    uint32_t            nCalls;                 // Total number of measured process() calls
+                    uint32_t            nOverruns;              // Number of process() calls exceeding the deadline
+                    float               fMaxLoad;               // Maximum load ever measured
+                    uint32_t            vBins[LH_BINS];         // Load histogram
+                    latency_sample_t    vRing[LH_RING];         // Recent measurements
+                } latency_t;
+            #endif /* LSP_TIMING */
+
             protected:
                 inline dspu::equalizer_mode_t   get_eq_mode();
                 void                            dump_channel(dspu::IStateDumper *v, const eq_channel_t *c) const;
                 static void                     dump_band(dspu::IStateDumper *v, const eq_band_t *b);
+                void                            make_band_params(dspu::filter_params_t *fp, size_t band, float gain, size_t slope, bool matched) const;
+                static void                     resample_curve(float *dst, const float *src, const uint32_t *idx, const float *w, float *tmp, size_t count);
+                void                            reset_spectrum();
+                void                            accumulate_spectrum();
+                void                            get_spectrum(float *dst, const eq_channel_t *c, size_t channel, size_t index);
+                void                            update_latency();
+                status_t                        init_fir_equalizers();
+                void                            commit_fir_equalizers();
+            #ifdef LSP_TIMING
+                uint64_t                        profile_mark(size_t stage, uint64_t start);
+                void                            profile_commit(size_t samples, uint64_t duration);
+                static float                    latency_percentile(const uint32_t *bins, float p);
+            #endif /* LSP_TIMING */
 
             protected:
                 dspu::Analyzer      sAnalyzer;      // Analyzer
@@ -131,11 +220,29 @@ namespace lsp
                 uint32_t            nSlope;         // Slope
                 bool                bListen;        // Listen
                 bool                bMatched;       // Matched transorm/Bilinear transform flag
+                bool                bFirReady;      // Equalizers supporting FIR/FFT/SPM modes are initialized
+                bool                bFirLoaded;     // Equalizers supporting FIR/FFT/SPM modes have been initialized in init()
+                uint32_t            nEqMode;        // Requested equalizer mode
                 float               fInGain;        // Input gain
                 float               fZoom;          // Zoom gain
+                uint32_t            nChartSerial;   // Serial number of the transfer functions
+                uint32_t            nFftView;       // Spectrum view mode
+                uint32_t            nFftPeriod;     // Spectrum accumulation period in samples
+                uint32_t            nFftCounter;    // Spectrum accumulation counter
+                float               fFftAvgK;       // Long-term averaging coefficient
                 float              *vFreqs;         // Frequency list
+                float              *vFftBuf;        // Temporary spectrum buffer
+                float              *vTrRe;          // Temporary transfer function (real part)
+                float              *vTrIm;          // Temporary transfer function (imaginary part)
                 uint32_t           *vIndexes;       // FFT indexes
                 core::IDBuffer     *pIDisplay;      // Inline display buffer
+                idisplay_t          sIDisplay;      // Inline display cache state
+                uint8_t            *pData;          // Allocated data
+                FirLoader           sFirLoader;     // Background initialization of FIR/FFT/SPM equalizers
+            #ifdef LSP_TIMING
+                profiler_t          sProfiler;      // Per-stage processing time statistics
+                latency_t           sLatency;       // Processing time relative to the deadline
+            #endif /* LSP_TIMING */
 
                 plug::IPort        *pEqMode;        // Equalizer mode
                 plug::IPort        *pSlope;         // Filter slope
@@ -147,6 +254,9 @@ namespace lsp
                 plug::IPort        *pShiftGain;     // Shift gain
                 plug::IPort        *pZoom;          // Graph zoom
                 plug::IPort        *pBalance;       // Output balance
+                plug::IPort        *pFftView;       // Spectrum view mode
+                plug::IPort        *pFftAvgTime;    // Long-term average time
+                plug::IPort        *pFftReset;      // Long-term spectrum reset
 
             protected:
                 void                do_destroy();
@@ -43,8 +43,14 @@ namespace lsp
                     ws::rectangle_t sRect;      // The overall rectangle over the grid
 
                     bool bMouseIn;              // Mouse is over filter indicator
+                    bool bResolved;             // Lazily bound widgets and ports are resolved
+                    bool bGroup;                // Filter widget group has been queried
+                    char sSuffix[8];            // Identifier suffix of filter widgets and ports
 
                     float fFreq;
+                    ssize_t nGainStep;          // Gain step of the currently displayed info text
+
+                    const char *sLabelKey;      // Localization key of the filter label
 
                     ui::IPort *pGain;
                     ui::IPort *pOn;
@@ -56,15 +62,20 @@ namespace lsp
                     tk::GraphDot *wDot;         // Graph dot for editing
                     tk::GraphText *wInfo;       // Text with note and frequency
 
-                    tk::Knob *wGain;            // Gain button
+                    lltl::parray<tk::Widget> *pWidgets; // All widgets of the filter group
                 } filter_t;
 
             protected:
                 const char            **fmtStrings;
+                const char            **lblStrings;
                 size_t                  nFilters;
                 lltl::darray<filter_t>  vFilters;
                 lltl::parray<tk::Widget> vFilterGrids;   // List of filter grids
+                lltl::parray<filter_t>  vFilterIndex;   // Filters sorted by grid and horizontal position
                 filter_t               *pCurrFilter;
+                filter_t               *pHoverFilter;   // Filter under the mouse pointer
+                filter_t               *pInfoFilter;    // Filter which info text is currently shown
+                LSPString               sInfoLabel;     // Localized label of the filter which info text is currently shown
 
             protected:
                 static status_t slot_filter_mouse_in(tk::Widget *sender, void *ptr, void *data);
@@ -77,11 +88,16 @@ namespace lsp
 
             protected:
                 void add_filters();
+                void resolve_filter(filter_t *f);
+                void query_filter_group(filter_t *f);
 
                 void on_filter_mouse_in(filter_t *f);
                 void on_filter_mouse_out();
 
                 filter_t *find_filter_by_rect(tk::Widget *grid, ssize_t x, ssize_t y);
+                size_t find_filter_index(const tk::Widget *grid, ssize_t x);
+                void build_filter_index();
+                void show_filter_info(filter_t *f, bool visible);
                 void on_main_grid_realized(tk::Widget *w);
 
                 void on_main_grid_mouse_in(tk::Widget *w, ssize_t x, ssize_t y);
@@ -91,11 +107,12 @@ namespace lsp
                 tk::Widget *find_filter_grid(filter_t *f);
 
                 void update_filter_info_text();
+                void format_filter_label(LSPString *dst, filter_t *f);
 
                 template <class T>
-                T *find_filter_widget(const char *fmt, const char *base, size_t id);
+                T *find_filter_widget(const char *base, const filter_t *f);
 
-                ui::IPort *find_port(const char *fmt, const char *base, size_t id);
+                ui::IPort *find_port(const char *base, const filter_t *f);
 
             public:
                 explicit graph_equalizer_ui(const meta::plugin_t *meta);
@@ -138,6 +138,11 @@ ifeq ($(call fcheck,profile,$(BUILD_FEATURES),ON),ON)
   NOARCH_CXXFLAGS    += -pg -DLSP_PROFILE
 endif
 
+ifeq ($(call fcheck,timing,$(BUILD_FEATURES),ON),ON)
+  NOARCH_CFLAGS      += -DLSP_TIMING
+  NOARCH_CXXFLAGS    += -DLSP_TIMING
+endif
+
 ifeq ($(call fcheck,trace,$(BUILD_FEATURES),ON),ON)
   NOARCH_CFLAGS      += -DLSP_TRACE
   NOARCH_CXXFLAGS    += -DLSP_TRACE
@@ -263,5 +268,6 @@ toolvars:
 	echo "  profile                   Build with gprof profiling options"
 	echo "  strict                    Strict compilation: treat all compilation warning as errors"
 	echo "  test                      Enable tests and build test binary"
+	echo "  timing                    Collect processing time statistics without gprof instrumentation"
 	echo "  trace                     Enable output of additional trace logs"
 	echo ""
@@ -76,6 +76,14 @@
 	<li><b>FFT</b> - enables FFT analysis before or after filter processing stage.</li>
 	<li><b>Reactivity</b> - the reactivity (smoothness) of the spectral analysis.</li>
 	<li><b>Shift</b> - allows to adjust the overall gain of the analysis.</li>
+	<li><b>Average time</b> - the time constant of the long-term spectrum averaging.</li>
+	<li><b>Spectrum view</b> - selects the spectrum displayed on the graph:</li>
+	<ul>
+		<li><b>Realtime</b> - the current spectrum of the signal.</li>
+		<li><b>Average</b> - the long-term average of the spectrum.</li>
+		<li><b>Peak hold</b> - the maximum values of the spectrum.</li>
+	</ul>
+	<li><b>Reset</b> - resets the accumulated long-term average or peak hold spectrum.</li>
 </ul>
 <p><b>'Bands' section:</b></p>
 <ul>
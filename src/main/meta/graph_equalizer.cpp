@@ -26,7 +26,7 @@
 
 #define LSP_PLUGINS_GRAPH_EQUALIZER_VERSION_MAJOR       1
 #define LSP_PLUGINS_GRAPH_EQUALIZER_VERSION_MINOR       0
-#define LSP_PLUGINS_GRAPH_EQUALIZER_VERSION_MICRO       39
+#define LSP_PLUGINS_GRAPH_EQUALIZER_VERSION_MICRO       40
 
 #define LSP_PLUGINS_GRAPH_EQUALIZER_VERSION  \
     LSP_MODULE_VERSION( \
@@ -74,6 +74,14 @@ namespace lsp
             { NULL, NULL }
         };
 
+        static const port_item_t spectrum_views[] =
+        {
+            { "Realtime",               "graph_eq.spectrum.realtime" },
+            { "Average",                "graph_eq.spectrum.average" },
+            { "Peak hold",              "graph_eq.spectrum.peak_hold" },
+            { NULL, NULL }
+        };
+
         static const port_item_t band_select_16lr[] =
         {
             { "Bands Left",             "graph_eq.bands_l" },
@@ -171,7 +179,10 @@ namespace lsp
             COMBO("slope", "Filter slope", "Flt slope", 0, band_slopes), \
             LOG_CONTROL("react", "FFT reactivity", "Reactivity", U_MSEC, graph_equalizer_metadata::REACT_TIME), \
             AMP_GAIN("shift", "Shift gain", "Shift", 1.0f, 100.0f), \
-            LOG_CONTROL("zoom", "Graph zoom", "Zoom", U_GAIN_AMP, graph_equalizer_metadata::ZOOM)
+            LOG_CONTROL("zoom", "Graph zoom", "Zoom", U_GAIN_AMP, graph_equalizer_metadata::ZOOM), \
+            COMBO("fftv", "FFT spectrum view", "FFT view", graph_equalizer_metadata::SV_REALTIME, spectrum_views), \
+            LOG_CONTROL("ltat", "Long-term average time", "LT avg time", U_SEC, graph_equalizer_metadata::LTAVG_TIME), \
+            TRIGGER("fftrs", "FFT spectrum reset", "FFT reset")
 
         #define EQ_LINK(id, label, alias) \
             SWITCH(id, label, alias, 0.0f)
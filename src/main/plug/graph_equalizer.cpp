@@ -25,6 +25,11 @@
 #include <lsp-plug.in/plug-fw/core/AudioBuffer.h>
 #include <lsp-plug.in/stdlib/math.h>
 
+#ifdef LSP_TIMING
+    #include <lsp-plug.in/common/atomic.h>
+    #include <lsp-plug.in/runtime/system.h>
+#endif /* LSP_TIMING */
+
 #include <lsp-plug.in/shared/debug.h>
 #include <lsp-plug.in/shared/id_colors.h>
 
@@ -32,6 +37,21 @@
 
 #define EQ_BUFFER_SIZE          0x400U
 
+#ifdef LSP_TIMING
+    #define PROFILE_AVG_K           0.01f       /* Rolling mean coefficient per process() call */
+    #define PROFILE_MAX_DECAY       0.999f      /* Rolling maximum decay per process() call */
+
+    #define PROFILE_START()         const size_t prof_samples = samples; \
+                                    const uint64_t prof_start = profile_time_nanos(); \
+                                    uint64_t prof_time = prof_start
+    #define PROFILE_MARK(stage)     prof_time = profile_mark(stage, prof_time)
+    #define PROFILE_COMMIT()        profile_commit(prof_samples, prof_time - prof_start)
+#else
+    #define PROFILE_START()
+    #define PROFILE_MARK(stage)
+    #define PROFILE_COMMIT()
+#endif /* LSP_TIMING */
+
 namespace lsp
 {
     namespace plugins
@@ -81,11 +101,37 @@ namespace lsp
             }
 
             static plug::Factory factory(plugin_factory, plugins, 8);
+
+        #ifdef LSP_TIMING
+            static inline uint64_t profile_time_nanos()
+            {
+                system::time_t t;
+                system::get_time(&t);
+                return uint64_t(t.seconds) * 1000000000U + uint64_t(t.nanos);
+            }
+        #endif /* LSP_TIMING */
         } /* inline namespace */
 
+        //-------------------------------------------------------------------------
+        graph_equalizer::FirLoader::FirLoader(graph_equalizer *core)
+        {
+            pCore           = core;
+        }
+
+        graph_equalizer::FirLoader::~FirLoader()
+        {
+            pCore           = NULL;
+        }
+
+        status_t graph_equalizer::FirLoader::run()
+        {
+            return pCore->init_fir_equalizers();
+        }
+
         //-------------------------------------------------------------------------
         graph_equalizer::graph_equalizer(const meta::plugin_t *metadata, size_t bands, size_t mode):
-            plug::Module(metadata)
+            plug::Module(metadata),
+            sFirLoader(this)
         {
             vChannels       = NULL;
             nBands          = bands;
@@ -93,11 +139,53 @@ namespace lsp
             nSlope          = -1;
             bListen         = false;
             bMatched        = false;
+            bFirReady       = false;
+            bFirLoaded      = false;
+            nEqMode         = dspu::EQM_BYPASS;
             fInGain         = 1.0f;
             fZoom           = 1.0f;
+            nChartSerial    = 0;
+            nFftView        = meta::graph_equalizer_metadata::SV_REALTIME;
+            nFftPeriod      = 1;
+            nFftCounter     = 0;
+            fFftAvgK        = 1.0f;
             vFreqs          = NULL;
+            vFftBuf         = NULL;
+            vTrRe           = NULL;
+            vTrIm           = NULL;
             vIndexes        = NULL;
             pIDisplay       = NULL;
+            pData           = NULL;
+
+            sIDisplay.nWidth    = 0;
+            sIDisplay.nHeight   = 0;
+            sIDisplay.fZoom     = 0.0f;
+            sIDisplay.nSerial   = 0;
+            sIDisplay.nVLines   = 0;
+            sIDisplay.nHLines   = 0;
+
+        #ifdef LSP_TIMING
+            sProfiler.nCalls    = 0;
+            for (size_t i=0; i<PS_TOTAL; ++i)
+            {
+                sProfiler.vTime[i]  = 0.0f;
+                sProfiler.vMean[i]  = 0.0f;
+                sProfiler.vMax[i]   = 0.0f;
+            }
+
+            sLatency.nConfig    = 0;
+            sLatency.nHead      = 0;
+            sLatency.nCalls     = 0;
+            sLatency.nOverruns  = 0;
+            sLatency.fMaxLoad   = 0.0f;
+            for (size_t i=0; i<LH_BINS; ++i)
+                sLatency.vBins[i]   = 0;
+            for (size_t i=0; i<LH_RING; ++i)
+            {
+                sLatency.vRing[i].fLoad     = 0.0f;
+                sLatency.vRing[i].nConfig   = 0;
+            }
+        #endif /* LSP_TIMING */
 
             pEqMode         = NULL;
             pSlope          = NULL;
@@ -109,6 +197,9 @@ namespace lsp
             pShiftGain      = NULL;
             pZoom           = NULL;
             pBalance        = NULL;
+            pFftView        = NULL;
+            pFftAvgTime     = NULL;
+            pFftReset       = NULL;
         }
 
         graph_equalizer::~graph_equalizer()
@@ -123,46 +214,59 @@ namespace lsp
 
             // Determine number of channels
             size_t channels     = (nMode == EQ_MONO) ? 1 : 2;
-            size_t max_latency  = 0;
 
-            // Allocate channels
-            vChannels           = new eq_channel_t[channels];
-            if (vChannels == NULL)
+            // Estimate the size of all per-instance data
+            size_t szof_channels    = align_size(sizeof(eq_channel_t) * channels, OPTIMAL_ALIGN);
+            size_t szof_bands       = align_size(sizeof(eq_band_t) * nBands, OPTIMAL_ALIGN);
+            size_t szof_indexes     = align_size(sizeof(uint32_t) * meta::graph_equalizer_metadata::MESH_POINTS, OPTIMAL_ALIGN);
+            size_t buf_floats       = (EQ_BUFFER_SIZE*4 + (nBands + 4)*meta::graph_equalizer_metadata::MESH_POINTS) * channels + meta::graph_equalizer_metadata::MESH_POINTS*4;
+            size_t szof_buffers     = align_size(sizeof(float) * buf_floats, OPTIMAL_ALIGN);
+            size_t to_alloc         =
+                szof_channels +
+                szof_bands * channels +
+                szof_indexes +
+                szof_buffers;
+
+            // Allocate all data with one chunk
+            uint8_t *ptr            = alloc_aligned<uint8_t>(pData, to_alloc, OPTIMAL_ALIGN);
+            if (ptr == NULL)
                 return;
+            lsp_guard_assert(uint8_t *save = &ptr[to_alloc]);
 
             // Initialize global parameters
             fInGain             = 1.0f;
             bListen             = false;
 
-            // Allocate indexes
-            vIndexes            = new uint32_t[meta::graph_equalizer_metadata::MESH_POINTS];
-            if (vIndexes == NULL)
-                return;
-
-            // Allocate buffer
-            size_t allocate     = (EQ_BUFFER_SIZE*4 + (nBands + 1)*meta::graph_equalizer_metadata::MESH_POINTS*2) * channels + meta::graph_equalizer_metadata::MESH_POINTS;
-            float *abuf         = new float[allocate];
-            if (abuf == NULL)
-                return;
-            lsp_guard_assert(float *save = &abuf[allocate]);
+            vChannels           = advance_ptr_bytes<eq_channel_t>(ptr, szof_channels);
+            eq_band_t *bands    = advance_ptr_bytes<eq_band_t>(ptr, szof_bands * channels);
+            vIndexes            = advance_ptr_bytes<uint32_t>(ptr, szof_indexes);
+            float *abuf         = advance_ptr_bytes<float>(ptr, szof_buffers);
+            lsp_assert(ptr <= save);
 
             // Clear all floating-point buffers
-            dsp::fill_zero(abuf, allocate);
+            dsp::fill_zero(abuf, buf_floats);
 
-            vFreqs              = abuf;
-            abuf               += meta::graph_equalizer_metadata::MESH_POINTS;
+            vFreqs              = advance_ptr<float>(abuf, meta::graph_equalizer_metadata::MESH_POINTS);
+            vFftBuf             = advance_ptr<float>(abuf, meta::graph_equalizer_metadata::MESH_POINTS);
+            vTrRe               = advance_ptr<float>(abuf, meta::graph_equalizer_metadata::MESH_POINTS);
+            vTrIm               = advance_ptr<float>(abuf, meta::graph_equalizer_metadata::MESH_POINTS);
 
             // Allocate channel data
             for (size_t i=0; i<channels; ++i)
             {
                 // Allocate data
                 eq_channel_t *c     = &vChannels[i];
+
+                c->sIirEqualizer.construct();
+                c->sEqualizer.construct();
+                c->sBypass.construct();
+                c->sDryDelay.construct();
+                c->sFirDryDelay.construct();
+
                 c->nSync            = CS_UPDATE;
                 c->fInGain          = 1.0f;
                 c->fOutGain         = 1.0f;
-                c->vBands           = new eq_band_t[nBands];
-                if (c->vBands == NULL)
-                    return;
+                c->vBands           = &bands[i * nBands];
 
                 c->vIn              = NULL;
                 c->vOut             = NULL;
@@ -174,8 +278,14 @@ namespace lsp
                 c->vInBuffer        = advance_ptr<float>(abuf, EQ_BUFFER_SIZE);
                 c->vOutBuffer       = advance_ptr<float>(abuf, EQ_BUFFER_SIZE);
                 c->vExtBuffer       = advance_ptr<float>(abuf, EQ_BUFFER_SIZE);
-                c->vTrRe            = advance_ptr<float>(abuf, meta::graph_equalizer_metadata::MESH_POINTS);
-                c->vTrIm            = advance_ptr<float>(abuf, meta::graph_equalizer_metadata::MESH_POINTS);
+                c->vTrAmp           = advance_ptr<float>(abuf, meta::graph_equalizer_metadata::MESH_POINTS);
+
+                for (size_t j=0; j<3; ++j)
+                {
+                    c->bFftOn[j]        = false;
+                    c->nFftFrames[j]    = 0;
+                    c->vFftAcc[j]       = advance_ptr<float>(abuf, meta::graph_equalizer_metadata::MESH_POINTS);
+                }
 
                 c->pIn              = NULL;
                 c->pOut             = NULL;
@@ -193,9 +303,8 @@ namespace lsp
                 c->pInMeter         = NULL;
                 c->pOutMeter        = NULL;
 
-                // Initialize equalizer
-                c->sEqualizer.init(nBands, meta::graph_equalizer_metadata::FFT_RANK);
-                max_latency         = lsp_max(max_latency, c->sEqualizer.max_latency());
+                c->pEqualizer       = &c->sIirEqualizer;
+                c->pDryDelay        = &c->sDryDelay;
 
                 for (size_t j=0; j<nBands; ++j)
                 {
@@ -203,8 +312,7 @@ namespace lsp
 
                     b->bSolo        = false;
                     b->nSync        = CS_UPDATE;
-                    b->vTrRe        = advance_ptr<float>(abuf, meta::graph_equalizer_metadata::MESH_POINTS);
-                    b->vTrIm        = advance_ptr<float>(abuf, meta::graph_equalizer_metadata::MESH_POINTS);
+                    b->vTrAmp       = advance_ptr<float>(abuf, meta::graph_equalizer_metadata::MESH_POINTS);
 
                     b->pGain        = NULL;
                     b->pSolo        = NULL;
@@ -213,16 +321,40 @@ namespace lsp
                     b->pVisibility  = NULL;
                 }
             }
-            lsp_assert(abuf <= save);
 
-            // Initialize latency compensation delay
+            // Initialize equalizers for IIR mode only and latency compensation delays after all channels
+            // have been constructed, buffers for FIR/FFT/SPM modes are allocated on demand
             for (size_t i=0; i<channels; ++i)
             {
                 eq_channel_t *c     = &vChannels[i];
-                if (!c->sDryDelay.init(max_latency))
+                if (!c->sIirEqualizer.init(nBands, 0))
+                    return;
+                if (!c->sDryDelay.init(c->sIirEqualizer.max_latency()))
                     return;
             }
 
+            // Without executor the equalizers for FIR/FFT/SPM modes can not be initialized
+            // in background, initialize them here to keep update_settings() allocation-free
+            if (pWrapper->executor() == NULL)
+            {
+                if (init_fir_equalizers() != STATUS_OK)
+                    return;
+                bFirLoaded          = true;
+            }
+
+            // Initialize analyzer for the maximum supported sample rate, so sample rate changes do not allocate memory
+            if (!sAnalyzer.init(
+                channels*3, meta::graph_equalizer_metadata::FFT_RANK,
+                MAX_SAMPLE_RATE, meta::graph_equalizer_metadata::REFRESH_RATE,
+                1 << (meta::graph_equalizer_metadata::FFT_RANK + 1)))
+                return;
+
+            sAnalyzer.set_rank(meta::graph_equalizer_metadata::FFT_RANK);
+            sAnalyzer.set_activity(false);
+            sAnalyzer.set_envelope(meta::graph_equalizer_metadata::FFT_ENVELOPE);
+            sAnalyzer.set_window(meta::graph_equalizer_metadata::FFT_WINDOW);
+            sAnalyzer.set_rate(meta::graph_equalizer_metadata::REFRESH_RATE);
+
             // Bind ports
             size_t port_id          = 0;
 
@@ -244,6 +376,9 @@ namespace lsp
             BIND_PORT(pReactivity);
             BIND_PORT(pShiftGain);
             BIND_PORT(pZoom);
+            BIND_PORT(pFftView);
+            BIND_PORT(pFftAvgTime);
+            BIND_PORT(pFftReset);
             if ((nMode == EQ_LEFT_RIGHT) || (nMode == EQ_MID_SIDE))
                 SKIP_PORT("Separate channels link");
 
@@ -350,30 +485,30 @@ namespace lsp
                 for (size_t i=0; i<channels; ++i)
                 {
                     eq_channel_t *c = &vChannels[i];
+                    c->sIirEqualizer.destroy();
                     c->sEqualizer.destroy();
-
-                    if (c->vBands != NULL)
-                    {
-                        delete [] c->vBands;
-                        c->vBands   = NULL;
-                    }
+                    c->sDryDelay.destroy();
+                    c->sFirDryDelay.destroy();
+                    c->pDryDelay    = NULL;
+                    c->pEqualizer   = NULL;
+                    c->vBands       = NULL;
                 }
 
-                delete[] vChannels;
                 vChannels       = NULL;
             }
 
-            if (vIndexes != NULL)
+            // Free all allocated data
+            if (pData != NULL)
             {
-                delete [] vIndexes;
-                vIndexes    = NULL;
+                free_aligned(pData);
+                pData           = NULL;
             }
 
-            if (vFreqs != NULL)
-            {
-                delete [] vFreqs;
-                vFreqs      = NULL;
-            }
+            vIndexes        = NULL;
+            vFreqs          = NULL;
+            vFftBuf         = NULL;
+            vTrRe           = NULL;
+            vTrIm           = NULL;
 
             if (pIDisplay != NULL)
             {
@@ -399,6 +534,35 @@ namespace lsp
             return dspu::EQM_BYPASS;
         }
 
+        void graph_equalizer::make_band_params(dspu::filter_params_t *fp, size_t band, float gain, size_t slope, bool matched) const
+        {
+            const float *freqs      = meta::graph_equalizer_metadata::band_frequencies;
+            const size_t step       = (nBands > 16) ? 1 : 2;
+
+            if (band == 0)
+            {
+                fp->nType       = (matched) ? dspu::FLT_MT_LRX_LOSHELF : dspu::FLT_BT_LRX_LOSHELF;
+                fp->fFreq       = sqrtf(freqs[0] * freqs[step]);
+                fp->fFreq2      = fp->fFreq;
+            }
+            else if (band == (nBands-1))
+            {
+                fp->nType       = (matched) ? dspu::FLT_MT_LRX_HISHELF : dspu::FLT_BT_LRX_HISHELF;
+                fp->fFreq       = sqrtf(freqs[(band-1)*step] * freqs[band*step]);
+                fp->fFreq2      = fp->fFreq;
+            }
+            else
+            {
+                fp->nType       = (matched) ? dspu::FLT_MT_LRX_LADDERPASS : dspu::FLT_BT_LRX_LADDERPASS;
+                fp->fFreq       = sqrtf(freqs[(band-1)*step] * freqs[band*step]);
+                fp->fFreq2      = sqrtf(freqs[band*step] * freqs[(band+1)*step]);
+            }
+
+            fp->fGain       = gain;
+            fp->nSlope      = slope;
+            fp->fQuality    = 0.0f;
+        }
+
         void graph_equalizer::update_settings()
         {
             // Check sample rate
@@ -453,6 +617,16 @@ namespace lsp
                 sAnalyzer.enable_channel(i*3, in_fft);
                 sAnalyzer.enable_channel(i*3 + 1, out_fft);
                 sAnalyzer.enable_channel(i*3 + 2, ext_fft);
+                c->bFftOn[0]        = in_fft;
+                c->bFftOn[1]        = out_fft;
+                c->bFftOn[2]        = ext_fft;
+
+                // Restart accumulation for disabled spectrum analysis channels
+                for (size_t j=0; j<3; ++j)
+                {
+                    if (!c->bFftOn[j])
+                        c->nFftFrames[j]    = 0;
+                }
                 if ((in_fft) || (out_fft) || (ext_fft))
                     ++n_an_channels;
             }
@@ -463,6 +637,15 @@ namespace lsp
             if (pShiftGain != NULL)
                 sAnalyzer.set_shift(pShiftGain->value() * 100.0f);
 
+            // Update long-term spectrum settings
+            size_t fft_view             = pFftView->value();
+            if ((fft_view != nFftView) || (pFftReset->value() >= 0.5f))
+            {
+                nFftView                    = fft_view;
+                reset_spectrum();
+            }
+            fFftAvgK                    = 1.0f - expf(-float(nFftPeriod) / (fSampleRate * pFftAvgTime->value()));
+
             // Listen flag
             if (pListen != NULL)
                 bListen         = pListen->value() >= 0.5f;
@@ -471,11 +654,15 @@ namespace lsp
             bool bypass                 = pBypass->value() >= 0.5f;
             bool solo                   = false;
             bool matched_tr             = bMatched;
-            size_t step                 = (nBands > 16) ? 1 : 2;
 
             bMatched                    = (slope & 1) != 0;
             fInGain                     = pInGain->value();
             dspu::equalizer_mode_t eq_mode  = get_eq_mode();
+            const bool fir_mode         = (eq_mode != dspu::EQM_IIR) && (eq_mode != dspu::EQM_BYPASS);
+            nEqMode                     = eq_mode;
+        #ifdef LSP_TIMING
+            sLatency.nConfig            = (uint32_t(eq_mode) << 16) | uint32_t(slope);
+        #endif /* LSP_TIMING */
             slope                       = meta::graph_equalizer_metadata::SLOPE_MIN + (slope >> 1);
 
             // Update channels
@@ -485,8 +672,8 @@ namespace lsp
                 eq_channel_t *c     = &vChannels[i];
                 bool visible        = (c->pVisible == NULL) ? true : (c->pVisible->value() >= 0.5f);
 
-                // Update settings
-                c->sEqualizer.set_mode(eq_mode);
+                // Update settings, keep IIR mode until the equalizers for other modes become ready
+                c->pEqualizer->set_mode(((bFirReady) || (!fir_mode)) ? eq_mode : dspu::EQM_IIR);
                 if (c->sBypass.set_bypass(bypass))
                     pWrapper->query_display_draw();
                 c->fOutGain         = bal[i];
@@ -542,7 +729,7 @@ namespace lsp
                     b->pVisibility->set_value((b_vis) ? 1.0f : 0.0f);
 
                     // Fetch filter params
-                    c->sEqualizer.get_params(j, &fp);
+                    c->pEqualizer->get_params(j, &fp);
 
                     bool update         =
                         (fp.fGain != gain) ||
@@ -551,30 +738,8 @@ namespace lsp
 
                     if (update)
                     {
-                        if (j == 0)
-                        {
-                            fp.nType        = (bMatched) ? dspu::FLT_MT_LRX_LOSHELF : dspu::FLT_BT_LRX_LOSHELF;
-                            fp.fFreq        = sqrtf(meta::graph_equalizer_metadata::band_frequencies[0] * meta::graph_equalizer_metadata::band_frequencies[step]);
-                            fp.fFreq2       = fp.fFreq;
-                        }
-                        else if (j == (nBands-1))
-                        {
-                            fp.nType        = (bMatched) ? dspu::FLT_MT_LRX_HISHELF : dspu::FLT_BT_LRX_HISHELF;
-                            fp.fFreq        = sqrtf(meta::graph_equalizer_metadata::band_frequencies[(j-1)*step] * meta::graph_equalizer_metadata::band_frequencies[j*step]);
-                            fp.fFreq2       = fp.fFreq;
-                        }
-                        else
-                        {
-                            fp.nType        = (bMatched) ? dspu::FLT_MT_LRX_LADDERPASS : dspu::FLT_BT_LRX_LADDERPASS;
-                            fp.fFreq        = sqrtf(meta::graph_equalizer_metadata::band_frequencies[(j-1)*step] * meta::graph_equalizer_metadata::band_frequencies[j*step]);
-                            fp.fFreq2       = sqrtf(meta::graph_equalizer_metadata::band_frequencies[j*step] * meta::graph_equalizer_metadata::band_frequencies[(j+1)*step]);
-                        }
-
-                        fp.fGain            = gain;
-                        fp.nSlope           = slope;
-                        fp.fQuality         = 0.0f;
-
-                        c->sEqualizer.set_params(j, &fp);
+                        make_band_params(&fp, j, gain, slope, bMatched);
+                        c->pEqualizer->set_params(j, &fp);
                         b->nSync           |= CS_UPDATE;
                     }
                 }
@@ -587,45 +752,95 @@ namespace lsp
                 sAnalyzer.get_frequencies(vFreqs, vIndexes, SPEC_FREQ_MIN, SPEC_FREQ_MAX, meta::graph_equalizer_metadata::MESH_POINTS);
             }
 
+            // Request initialization of equalizers for FIR/FFT/SPM modes
+            if ((fir_mode) && (!bFirReady))
+            {
+                ipc::IExecutor *executor = pWrapper->executor();
+                if (bFirLoaded)
+                    commit_fir_equalizers();
+                else if ((executor != NULL) && (sFirLoader.idle()))
+                    executor->submit(&sFirLoader);
+            }
+
             // Update latency
+            update_latency();
+        }
+
+        void graph_equalizer::update_latency()
+        {
+            size_t channels         = (nMode == EQ_MONO) ? 1 : 2;
             size_t latency          = 0;
             for (size_t i=0; i<channels; ++i)
-                latency                 = lsp_max(latency, vChannels[i].sEqualizer.get_latency());
+                latency                 = lsp_max(latency, vChannels[i].pEqualizer->get_latency());
 
             for (size_t i=0; i<channels; ++i)
             {
-                vChannels[i].sDryDelay.set_delay(latency);
+                vChannels[i].pDryDelay->set_delay(latency);
                 sAnalyzer.set_channel_delay(i*3, latency);  // delay left and right inputs
             }
             set_latency(latency);
         }
 
+        status_t graph_equalizer::init_fir_equalizers()
+        {
+            size_t channels         = (nMode == EQ_MONO) ? 1 : 2;
+
+            for (size_t i=0; i<channels; ++i)
+            {
+                eq_channel_t *c         = &vChannels[i];
+                if (!c->sEqualizer.init(nBands, meta::graph_equalizer_metadata::FFT_RANK))
+                    return STATUS_NO_MEM;
+                if (!c->sFirDryDelay.init(c->sEqualizer.max_latency()))
+                    return STATUS_NO_MEM;
+            }
+
+            return STATUS_OK;
+        }
+
+        void graph_equalizer::commit_fir_equalizers()
+        {
+            size_t channels         = (nMode == EQ_MONO) ? 1 : 2;
+            dspu::filter_params_t fp;
+
+            // Transfer the current state to the new equalizers and activate them
+            for (size_t i=0; i<channels; ++i)
+            {
+                eq_channel_t *c         = &vChannels[i];
+                c->sEqualizer.set_sample_rate(fSampleRate);
+                c->sEqualizer.set_mode(dspu::equalizer_mode_t(nEqMode));
+                for (size_t j=0; j<nBands; ++j)
+                {
+                    c->sIirEqualizer.get_params(j, &fp);
+                    c->sEqualizer.set_params(j, &fp);
+                }
+                c->pEqualizer           = &c->sEqualizer;
+                c->pDryDelay            = &c->sFirDryDelay;
+            }
+
+            bFirReady               = true;
+            update_latency();
+        }
+
         void graph_equalizer::update_sample_rate(long sr)
         {
             size_t channels     = (nMode == EQ_MONO) ? 1 : 2;
-            size_t max_latency  = 1 << (meta::graph_equalizer_metadata::FFT_RANK + 1);
 
             // Initialize channels
             for (size_t i=0; i<channels; ++i)
             {
                 eq_channel_t *c     = &vChannels[i];
                 c->sBypass.init(sr);
-                c->sEqualizer.set_sample_rate(sr);
+                c->sIirEqualizer.set_sample_rate(sr);
+                if (bFirReady)
+                    c->sEqualizer.set_sample_rate(sr);
             }
 
-            // Initialize analyzer
-            if (!sAnalyzer.init(
-                channels*3, meta::graph_equalizer_metadata::FFT_RANK,
-                sr, meta::graph_equalizer_metadata::REFRESH_RATE,
-                max_latency))
-                return;
-
+            // Update analyzer, the actual reconfiguration is performed in update_settings()
             sAnalyzer.set_sample_rate(sr);
-            sAnalyzer.set_rank(meta::graph_equalizer_metadata::FFT_RANK);
-            sAnalyzer.set_activity(false);
-            sAnalyzer.set_envelope(meta::graph_equalizer_metadata::FFT_ENVELOPE);
-            sAnalyzer.set_window(meta::graph_equalizer_metadata::FFT_WINDOW);
-            sAnalyzer.set_rate(meta::graph_equalizer_metadata::REFRESH_RATE);
+
+            // Reset long-term spectrum
+            nFftPeriod          = lsp_max(size_t(sr / meta::graph_equalizer_metadata::REFRESH_RATE), size_t(1));
+            reset_spectrum();
         }
 
         void graph_equalizer::ui_activated()
@@ -655,12 +870,147 @@ namespace lsp
 
             // Perform FFT analysis
             sAnalyzer.process(bufs, samples);
+
+            // Update long-term spectrum with the fixed rate
+            if (nFftView == meta::graph_equalizer_metadata::SV_REALTIME)
+                return;
+            nFftCounter        += samples;
+            if (nFftCounter < nFftPeriod)
+                return;
+            nFftCounter        -= nFftPeriod;
+            accumulate_spectrum();
+        }
+
+        void graph_equalizer::reset_spectrum()
+        {
+            size_t channels     = (nMode == EQ_MONO) ? 1 : 2;
+
+            for (size_t i=0; i<channels; ++i)
+            {
+                eq_channel_t *c     = &vChannels[i];
+                for (size_t j=0; j<3; ++j)
+                    c->nFftFrames[j]    = 0;
+            }
+            nFftCounter         = 0;
         }
 
+        void graph_equalizer::accumulate_spectrum()
+        {
+            size_t channels     = (nMode == EQ_MONO) ? 1 : 2;
+            const bool peak     = nFftView == meta::graph_equalizer_metadata::SV_PEAK_HOLD;
+
+            for (size_t i=0; i<channels; ++i)
+            {
+                eq_channel_t *c     = &vChannels[i];
+                for (size_t j=0; j<3; ++j)
+                {
+                    if (!c->bFftOn[j])
+                        continue;
+
+                    // Use cumulative mean until the averaging window becomes filled, exponential averaging after
+                    const size_t frames = c->nFftFrames[j]++;
+                    const float k       = lsp_max(1.0f / float(frames + 1), fFftAvgK);
+                    float *acc          = c->vFftAcc[j];
+
+                    sAnalyzer.get_spectrum(i*3 + j, vFftBuf, vIndexes, meta::graph_equalizer_metadata::MESH_POINTS);
+                    if ((peak) && (frames > 0))
+                        dsp::pmax2(acc, vFftBuf, meta::graph_equalizer_metadata::MESH_POINTS);
+                    else
+                        dsp::mix2(acc, vFftBuf, 1.0f - k, k, meta::graph_equalizer_metadata::MESH_POINTS);
+                }
+            }
+        }
+
+        void graph_equalizer::get_spectrum(float *dst, const eq_channel_t *c, size_t channel, size_t index)
+        {
+            if ((nFftView == meta::graph_equalizer_metadata::SV_REALTIME) || (c->nFftFrames[index] <= 0))
+                sAnalyzer.get_spectrum(channel*3 + index, dst, vIndexes, meta::graph_equalizer_metadata::MESH_POINTS);
+            else
+                dsp::copy(dst, c->vFftAcc[index], meta::graph_equalizer_metadata::MESH_POINTS);
+        }
+
+    #ifdef LSP_TIMING
+        uint64_t graph_equalizer::profile_mark(size_t stage, uint64_t start)
+        {
+            const uint64_t now      = profile_time_nanos();
+            sProfiler.vTime[stage] += float(now - start) * 1e-3f;
+            return now;
+        }
+
+        void graph_equalizer::profile_commit(size_t samples, uint64_t duration)
+        {
+            // Use cumulative mean for the first calls, rolling mean after
+            const float k           = lsp_max(1.0f / float(sProfiler.nCalls + 1), PROFILE_AVG_K);
+            for (size_t i=0; i<PS_TOTAL; ++i)
+            {
+                const float t           = sProfiler.vTime[i];
+                sProfiler.vMean[i]     += (t - sProfiler.vMean[i]) * k;
+                sProfiler.vMax[i]       = lsp_max(t, sProfiler.vMax[i] * PROFILE_MAX_DECAY);
+                sProfiler.vTime[i]      = 0.0f;
+            }
+            ++sProfiler.nCalls;
+
+            // Measure the load relative to the deadline
+            if ((samples <= 0) || (fSampleRate <= 0))
+                return;
+
+            const float load        = float(duration) * fSampleRate * 1e-9f / float(samples);
+            const size_t bin        = lsp_min(size_t(load * (LH_BINS / 2)), size_t(LH_BINS - 1));
+            ++sLatency.vBins[bin];
+            ++sLatency.nCalls;
+            if (load > 1.0f)
+                ++sLatency.nOverruns;
+            sLatency.fMaxLoad       = lsp_max(sLatency.fMaxLoad, load);
+
+            // Store the sample first and only then publish the new head
+            const uint32_t head     = sLatency.nHead;
+            latency_sample_t *ls    = &sLatency.vRing[head % LH_RING];
+            ls->fLoad               = load;
+            ls->nConfig             = sLatency.nConfig;
+            atomic_store(&sLatency.nHead, head + 1);
+        }
+
+        float graph_equalizer::latency_percentile(const uint32_t *bins, float p)
+        {
+            size_t total            = 0;
+            for (size_t i=0; i<LH_BINS; ++i)
+                total                  += bins[i];
+            if (total <= 0)
+                return 0.0f;
+
+            // Return the upper bound of the bin where the percentile is reached
+            const size_t limit      = size_t(ceilf(total * p));
+            size_t count            = 0;
+            for (size_t i=0; i<LH_BINS; ++i)
+            {
+                count                  += bins[i];
+                if (count >= limit)
+                    return float(i + 1) / float(LH_BINS / 2);
+            }
+
+            return float(LH_BINS) / float(LH_BINS / 2);
+        }
+    #endif /* LSP_TIMING */
+
         void graph_equalizer::process(size_t samples)
         {
+            PROFILE_START();
             size_t channels     = (nMode == EQ_MONO) ? 1 : 2;
 
+            // Number of band transfer functions to compute in this call, the full refresh of
+            // all bands should fit into one display refresh period (nFftPeriod samples)
+            size_t chart_bands  = (nBands * channels * samples + nFftPeriod - 1) / nFftPeriod;
+
+            // Switch to the equalizers supporting all modes once they have been initialized
+            if (sFirLoader.completed())
+            {
+                if (sFirLoader.code() == STATUS_OK)
+                    commit_fir_equalizers();
+                else
+                    lsp_warn("Failed to initialize equalizers for FIR/FFT/SPM modes, code=%d", int(sFirLoader.code()));
+                sFirLoader.reset();
+            }
+
             // Initialize buffer pointers
             for (size_t i=0; i<channels; ++i)
             {
@@ -697,7 +1047,7 @@ namespace lsp
                 for (size_t i=0; i<channels; ++i)
                 {
                     eq_channel_t *c     = &vChannels[i];
-                    c->sDryDelay.process(c->vDryBuf, c->vIn, to_process);
+                    c->pDryDelay->process(c->vDryBuf, c->vIn, to_process);
                 }
 
                 // Pre-process data
@@ -772,6 +1122,7 @@ namespace lsp
                     l->pInMeter->set_value(dsp::abs_max(l->vInPtr, to_process));
                     r->pInMeter->set_value(dsp::abs_max(r->vInPtr, to_process));
                 }
+                PROFILE_MARK(PS_PRE_PROCESS);
 
                 // Process each channel individually
                 for (size_t i=0; i<channels; ++i)
@@ -779,13 +1130,15 @@ namespace lsp
                     eq_channel_t *c     = &vChannels[i];
 
                     // Process the signal by the equalizer
-                    c->sEqualizer.process(c->vOutBuffer, c->vInPtr, to_process);
+                    c->pEqualizer->process(c->vOutBuffer, c->vInPtr, to_process);
                     if (c->fInGain != 1.0f)
                         dsp::mul_k2(c->vOutBuffer, c->fInGain, to_process);
                 }
+                PROFILE_MARK(PS_EQUALIZER);
 
                 // Call analyzer
                 perform_analysis(to_process);
+                PROFILE_MARK(PS_ANALYSIS);
 
                 // Post-process data (if needed)
                 if ((nMode == EQ_MID_SIDE) && (!bListen))
@@ -821,6 +1174,7 @@ namespace lsp
                     if (c->vReturn != NULL)
                         c->vReturn         += to_process;
                 }
+                PROFILE_MARK(PS_POST_PROCESS);
 
                 // Update counter
                 samples            -= to_process;
@@ -843,7 +1197,7 @@ namespace lsp
 
                     // Copy frequency points
                     dsp::copy(&mesh->pvData[0][1], vFreqs, meta::graph_equalizer_metadata::MESH_POINTS);
-                    sAnalyzer.get_spectrum(i*3, &mesh->pvData[1][1], vIndexes, meta::graph_equalizer_metadata::MESH_POINTS);
+                    get_spectrum(&mesh->pvData[1][1], c, i, 0);
 
                     // Mark mesh containing data
                     mesh->data(2, meta::graph_equalizer_metadata::MESH_POINTS + 2);
@@ -855,7 +1209,7 @@ namespace lsp
                 {
                     // Copy frequency points
                     dsp::copy(mesh->pvData[0], vFreqs, meta::graph_equalizer_metadata::MESH_POINTS);
-                    sAnalyzer.get_spectrum(i*3 + 1, mesh->pvData[1], vIndexes, meta::graph_equalizer_metadata::MESH_POINTS);
+                    get_spectrum(mesh->pvData[1], c, i, 1);
 
                     // Mark mesh containing data
                     mesh->data(2, meta::graph_equalizer_metadata::MESH_POINTS);
@@ -867,7 +1221,7 @@ namespace lsp
                 {
                     // Copy frequency points
                     dsp::copy(mesh->pvData[0], vFreqs, meta::graph_equalizer_metadata::MESH_POINTS);
-                    sAnalyzer.get_spectrum(i*3 + 2, mesh->pvData[1], vIndexes, meta::graph_equalizer_metadata::MESH_POINTS);
+                    get_spectrum(mesh->pvData[1], c, i, 2);
 
                     // Mark mesh containing data
                     mesh->data(2, meta::graph_equalizer_metadata::MESH_POINTS);
@@ -878,10 +1232,11 @@ namespace lsp
             if (nMode == EQ_STEREO)
                 channels        = 1;
 
-            // Sync meshes
+            // Sync meshes, spread the computation of band transfer functions between several calls
             for (size_t i=0; i<channels; ++i)
             {
                 eq_channel_t *c     = &vChannels[i];
+                bool pending        = false;
 
                 // Synchronize bands
                 for (size_t j=0; j<nBands; ++j)
@@ -890,25 +1245,32 @@ namespace lsp
                     eq_band_t *b  = &c->vBands[j];
                     if (b->nSync & CS_UPDATE)
                     {
-                        c->sEqualizer.freq_chart(j, b->vTrRe, b->vTrIm, vFreqs, meta::graph_equalizer_metadata::MESH_POINTS);
+                        if (chart_bands <= 0)
+                        {
+                            pending         = true;
+                            break;
+                        }
+                        --chart_bands;
+
+                        c->pEqualizer->freq_chart(j, vTrRe, vTrIm, vFreqs, meta::graph_equalizer_metadata::MESH_POINTS);
+                        dsp::complex_mod(b->vTrAmp, vTrRe, vTrIm, meta::graph_equalizer_metadata::MESH_POINTS);
                         b->nSync    = 0;
                         c->nSync    = CS_UPDATE;
                     }
                 }
 
-                // Synchronize main transfer function of the channel
-                if (c->nSync & CS_UPDATE)
+                // Synchronize main transfer function of the channel when all bands are ready
+                if ((c->nSync & CS_UPDATE) && (!pending))
                 {
-                    // Initialize complex numbers for transfer function
-                    dsp::fill_one(c->vTrRe, meta::graph_equalizer_metadata::MESH_POINTS);
-                    dsp::fill_zero(c->vTrIm, meta::graph_equalizer_metadata::MESH_POINTS);
-
-                    for (size_t j=0; j<nBands; ++j)
+                    // The amplitude of the product of transfer functions is the product of their amplitudes
+                    dsp::copy(c->vTrAmp, c->vBands[0].vTrAmp, meta::graph_equalizer_metadata::MESH_POINTS);
+                    for (size_t j=1; j<nBands; ++j)
                     {
                         eq_band_t *b  = &c->vBands[j];
-                        dsp::complex_mul2(c->vTrRe, c->vTrIm, b->vTrRe, b->vTrIm, meta::graph_equalizer_metadata::MESH_POINTS);
+                        dsp::mul2(c->vTrAmp, b->vTrAmp, meta::graph_equalizer_metadata::MESH_POINTS);
                     }
                     c->nSync    = CS_SYNC_AMP;
+                    ++nChartSerial;
                 }
 
                 // Output amplification curve
@@ -929,7 +1291,7 @@ namespace lsp
 
                         // Amplitude
                         pf          = mesh->pvData[1];
-                        dsp::complex_mod(&pf[2], c->vTrRe, c->vTrIm, meta::graph_equalizer_metadata::MESH_POINTS);
+                        dsp::copy(&pf[2], c->vTrAmp, meta::graph_equalizer_metadata::MESH_POINTS);
                         pf[0]       = GAIN_AMP_0_DB;
                         pf[1]       = pf[2];
                         pf         += meta::graph_equalizer_metadata::MESH_POINTS + 2;
@@ -947,6 +1309,9 @@ namespace lsp
                         pWrapper->query_display_draw();
                 }
             }
+
+            PROFILE_MARK(PS_MESH_SYNC);
+            PROFILE_COMMIT();
         }
 
         bool graph_equalizer::inline_display(plug::ICanvas *cv, size_t width, size_t height)
@@ -961,50 +1326,102 @@ namespace lsp
             width   = cv->width();
             height  = cv->height();
 
-            // Clear background
-            bool bypassing = vChannels[0].sBypass.bypassing();
-            cv->set_color_rgb((bypassing) ? CV_DISABLED : CV_BACKGROUND);
-            cv->paint();
+            // Allocate buffer: x, y (first channel), y (second channel), mesh, a0, a1, weights, indexes
+            core::IDBuffer *b   = core::IDBuffer::reuse(pIDisplay, 8, lsp_max(width+2, size_t(meta::graph_equalizer_metadata::MESH_POINTS)));
+            const bool realloc  = (b != pIDisplay);
+            pIDisplay           = b;
+            if (b == NULL)
+                return false;
 
-            // Draw axis
-            cv->set_line_width(1.0);
+            idisplay_t *id      = &sIDisplay;
+            uint32_t *idx       = reinterpret_cast<uint32_t *>(b->v[7]);
+            size_t channels     = ((nMode == EQ_MONO) || (nMode == EQ_STEREO)) ? 1 : 2;
 
             float zx    = 1.0f/SPEC_FREQ_MIN;
             float zy    = fZoom/GAIN_AMP_M_48_DB;
             float dx    = width/(logf(SPEC_FREQ_MAX)-logf(SPEC_FREQ_MIN));
             float dy    = height/(logf(GAIN_AMP_M_48_DB/fZoom)-logf(GAIN_AMP_P_48_DB*fZoom));
 
-            // Draw vertical lines
-            cv->set_color_rgb(CV_YELLOW, 0.5f);
-            for (float i=100.0f; i<SPEC_FREQ_MAX; i *= 10.0f)
+            // Update the grid and resampling tables only if the geometry has changed
+            const bool geometry = (realloc) || (id->nWidth != width) || (id->nHeight != height) || (id->fZoom != fZoom);
+            if (geometry)
             {
-                float ax = dx*(logf(i*zx));
-                cv->line(ax, 0, ax, height);
+                id->nWidth          = width;
+                id->nHeight         = height;
+                id->fZoom           = fZoom;
+
+                id->nVLines         = 0;
+                for (float i=100.0f; (i<SPEC_FREQ_MAX) && (id->nVLines < sizeof(id->vVLines)/sizeof(float)); i *= 10.0f)
+                    id->vVLines[id->nVLines++]  = dx*(logf(i*zx));
+
+                id->nHLines         = 0;
+                for (float i=GAIN_AMP_M_48_DB; (i<GAIN_AMP_P_48_DB) && (id->nHLines < sizeof(id->vHLines)/sizeof(float)); i *= GAIN_AMP_P_12_DB)
+                    id->vHLines[id->nHLines++]  = height + dy*(logf(i*zy));
+
+                // Compute mesh point index and interpolation weight for each pixel
+                float *w            = b->v[6];
+                const float kp      = (width > 1) ? float(meta::graph_equalizer_metadata::MESH_POINTS - 1) / float(width - 1) : 0.0f;
+                for (size_t j=0; j<width; ++j)
+                {
+                    float p             = j * kp;
+                    size_t k            = lsp_min(size_t(p), meta::graph_equalizer_metadata::MESH_POINTS - 2);
+                    idx[j]              = k;
+                    w[j]                = p - k;
+                }
             }
 
-            // Draw horizontal lines
-            cv->set_color_rgb(CV_WHITE, 0.5f);
-            for (float i=GAIN_AMP_M_48_DB; i<GAIN_AMP_P_48_DB; i *= GAIN_AMP_P_12_DB)
+            // Update curves only if the geometry or the transfer functions have changed
+            const uint32_t serial   = nChartSerial;
+            if ((geometry) || (id->nSerial != serial))
             {
-                float ay = height + dy*(logf(i*zy));
-                cv->line(0, ay, width, ay);
+                id->nSerial         = serial;
+
+                float *x            = b->v[0];
+                float *m            = b->v[3];
+                float *a            = b->v[4];
+                float *t            = b->v[5];
+                float *w            = b->v[6];
+
+                // Frequency axis
+                dsp::fill_zero(m, meta::graph_equalizer_metadata::MESH_POINTS);
+                dsp::axis_apply_log1(m, vFreqs, zx, dx, meta::graph_equalizer_metadata::MESH_POINTS);
+                x[0]                = dx*logf(SPEC_FREQ_MIN*0.5f*zx);
+                x[width+1]          = dx*logf(SPEC_FREQ_MAX*2.0f*zx);
+                resample_curve(&x[1], m, idx, w, t, width);
+
+                // Amplitude curves
+                for (size_t i=0; i<channels; ++i)
+                {
+                    eq_channel_t *c     = &vChannels[i];
+                    float *y            = b->v[i+1];
+
+                    a[0]                = 1.0f;
+                    a[width+1]          = 1.0f;
+                    resample_curve(&a[1], c->vTrAmp, idx, w, t, width);
+
+                    dsp::fill(y, height, width+2);
+                    dsp::axis_apply_log1(y, a, zy, dy, width+2);
+                }
             }
 
-            // Allocate buffer: f, x, y, re, im
-            pIDisplay           = core::IDBuffer::reuse(pIDisplay, 5, width+2);
-            core::IDBuffer *b   = pIDisplay;
-            if (b == NULL)
-                return false;
+            // Clear background
+            bool bypassing = vChannels[0].sBypass.bypassing();
+            cv->set_color_rgb((bypassing) ? CV_DISABLED : CV_BACKGROUND);
+            cv->paint();
 
-            // Initialize mesh
-            b->v[0][0]          = SPEC_FREQ_MIN*0.5f;
-            b->v[0][width+1]    = SPEC_FREQ_MAX*2.0f;
-            b->v[3][0]          = 1.0f;
-            b->v[3][width+1]    = 1.0f;
-            b->v[4][0]          = 0.0f;
-            b->v[4][width+1]    = 0.0f;
+            // Draw axis
+            cv->set_line_width(1.0);
+
+            // Draw vertical lines
+            cv->set_color_rgb(CV_YELLOW, 0.5f);
+            for (size_t i=0; i<id->nVLines; ++i)
+                cv->line(id->vVLines[i], 0, id->vVLines[i], height);
+
+            // Draw horizontal lines
+            cv->set_color_rgb(CV_WHITE, 0.5f);
+            for (size_t i=0; i<id->nHLines; ++i)
+                cv->line(0, id->vHLines[i], width, id->vHLines[i]);
 
-            size_t channels = ((nMode == EQ_MONO) || (nMode == EQ_STEREO)) ? 1 : 2;
             static uint32_t c_colors[] = {
                     CV_MIDDLE_CHANNEL, CV_MIDDLE_CHANNEL,
                     CV_MIDDLE_CHANNEL, CV_MIDDLE_CHANNEL,
@@ -1017,40 +1434,38 @@ namespace lsp
 
             for (size_t i=0; i<channels; ++i)
             {
-                eq_channel_t *c = &vChannels[i];
-
-                for (size_t j=0; j<width; ++j)
-                {
-                    size_t k        = (j*meta::graph_equalizer_metadata::MESH_POINTS)/width;
-                    b->v[0][j+1]    = vFreqs[k];
-                    b->v[3][j+1]    = c->vTrRe[k];
-                    b->v[4][j+1]    = c->vTrIm[k];
-                }
-
-                dsp::complex_mod(b->v[3], b->v[3], b->v[4], width+2);
-                dsp::fill(b->v[1], 0.0f, width+2);
-                dsp::fill(b->v[2], height, width+2);
-                dsp::axis_apply_log1(b->v[1], b->v[0], zx, dx, width+2);
-                dsp::axis_apply_log1(b->v[2], b->v[3], zy, dy, width+2);
-
                 // Draw mesh
                 uint32_t color = (bypassing || !(active())) ? CV_SILVER : c_colors[nMode*2 + i];
                 Color stroke(color), fill(color, 0.5f);
-                cv->draw_poly(b->v[1], b->v[2], width+2, stroke, fill);
+                cv->draw_poly(b->v[0], b->v[i+1], width+2, stroke, fill);
             }
             cv->set_anti_aliasing(aa);
 
             return true;
         }
 
+        void graph_equalizer::resample_curve(float *dst, const float *src, const uint32_t *idx, const float *w, float *tmp, size_t count)
+        {
+            // Gather the pair of neighbour points
+            for (size_t i=0; i<count; ++i)
+            {
+                const float *s      = &src[idx[i]];
+                dst[i]              = s[0];
+                tmp[i]              = s[1];
+            }
+
+            // Perform linear interpolation: dst = s[0] + (s[1] - s[0]) * w
+            dsp::sub2(tmp, dst, count);
+            dsp::fmadd3(dst, tmp, w, count);
+        }
+
         void graph_equalizer::dump_band(dspu::IStateDumper *v, const eq_band_t *b)
         {
             v->begin_object(b, sizeof(eq_band_t));
             {
                 v->write("bSolo", b->bSolo);
                 v->write("nSync", b->nSync);
-                v->write("vTrRe", b->vTrRe);
-                v->write("vTrIm", b->vTrIm);
+                v->write("vTrAmp", b->vTrAmp);
 
                 v->write("pGain", b->pGain);
                 v->write("pSolo", b->pSolo);
@@ -1065,9 +1480,13 @@ namespace lsp
         {
             v->begin_object(c, sizeof(eq_channel_t));
             {
+                v->write_object("sIirEqualizer", &c->sIirEqualizer);
                 v->write_object("sEqualizer", &c->sEqualizer);
+                v->write("pEqualizer", c->pEqualizer);
                 v->write_object("sBypass", &c->sBypass);
                 v->write_object("sDryDelay", &c->sDryDelay);
+                v->write_object("sFirDryDelay", &c->sFirDryDelay);
+                v->write("pDryDelay", c->pDryDelay);
 
                 v->write("nSync", c->nSync);
                 v->write("fInGain", c->fInGain);
@@ -1089,8 +1508,15 @@ namespace lsp
                 v->write("vInBuffer", c->vInBuffer);
                 v->write("vOutBuffer", c->vOutBuffer);
                 v->write("vExtBuffer", c->vExtBuffer);
-                v->write("vTrRe", c->vTrRe);
-                v->write("vTrIm", c->vTrIm);
+                v->write("vTrAmp", c->vTrAmp);
+                v->writev("bFftOn", c->bFftOn, 3);
+                v->writev("nFftFrames", c->nFftFrames, 3);
+                v->begin_array("vFftAcc", c->vFftAcc, 3);
+                {
+                    for (size_t i=0; i<3; ++i)
+                        v->write(c->vFftAcc[i]);
+                }
+                v->end_array();
 
                 v->write("pIn", c->pIn);
                 v->write("pOut", c->pOut);
@@ -1130,11 +1556,35 @@ namespace lsp
             v->write("nSlope", nSlope);
             v->write("bListen", bListen);
             v->write("bMatched", bMatched);
+            v->write("bFirReady", bFirReady);
+            v->write("bFirLoaded", bFirLoaded);
+            v->write("nEqMode", nEqMode);
             v->write("fInGain", fInGain);
             v->write("fZoom", fZoom);
+            v->write("nChartSerial", nChartSerial);
+            v->write("nFftView", nFftView);
+            v->write("nFftPeriod", nFftPeriod);
+            v->write("nFftCounter", nFftCounter);
+            v->write("fFftAvgK", fFftAvgK);
             v->write("vFreqs", vFreqs);
+            v->write("vFftBuf", vFftBuf);
+            v->write("vTrRe", vTrRe);
+            v->write("vTrIm", vTrIm);
             v->write("vIndexes", vIndexes);
             v->write_object("pIDisplay", pIDisplay);
+            v->write("pData", pData);
+            v->begin_object("sIDisplay", &sIDisplay, sizeof(idisplay_t));
+            {
+                v->write("nWidth", sIDisplay.nWidth);
+                v->write("nHeight", sIDisplay.nHeight);
+                v->write("fZoom", sIDisplay.fZoom);
+                v->write("nSerial", sIDisplay.nSerial);
+                v->write("nVLines", sIDisplay.nVLines);
+                v->write("nHLines", sIDisplay.nHLines);
+                v->writev("vVLines", sIDisplay.vVLines, sIDisplay.nVLines);
+                v->writev("vHLines", sIDisplay.vHLines, sIDisplay.nHLines);
+            }
+            v->end_object();
 
             v->write("pEqMode", pEqMode);
             v->write("pSlope", pSlope);
@@ -1146,6 +1596,66 @@ namespace lsp
             v->write("pShiftGain", pShiftGain);
             v->write("pZoom", pZoom);
             v->write("pBalance", pBalance);
+            v->write("pFftView", pFftView);
+            v->write("pFftAvgTime", pFftAvgTime);
+            v->write("pFftReset", pFftReset);
+
+        #ifdef LSP_TIMING
+            v->begin_object("sProfiler", &sProfiler, sizeof(profiler_t));
+            {
+                v->write("nCalls", sProfiler.nCalls);
+                v->writev("vTime", sProfiler.vTime, PS_TOTAL);
+                v->writev("vMean", sProfiler.vMean, PS_TOTAL);
+                v->writev("vMax", sProfiler.vMax, PS_TOTAL);
+            }
+            v->end_object();
+
+            // Take a snapshot of the histogram and the ring written by the audio thread
+            uint32_t bins[LH_BINS];
+            latency_sample_t ring[LH_RING];
+            const uint32_t head     = atomic_load(&sLatency.nHead);
+            for (size_t i=0; i<LH_BINS; ++i)
+                bins[i]                 = sLatency.vBins[i];
+            size_t n_ring           = lsp_min(size_t(head), size_t(LH_RING));
+            for (size_t i=0; i<n_ring; ++i)
+                ring[i]                 = sLatency.vRing[(head - n_ring + i) % LH_RING];
+
+            // Drop the oldest entries which could be overwritten while copying: the audio thread
+            // writes the entry at the new head before publishing it, so only entries newer than
+            // (new_head - LH_RING) are consistent
+            const uint32_t new_head = atomic_load(&sLatency.nHead);
+            const size_t written    = size_t(uint32_t(new_head - head)) + 1 + n_ring;
+            const size_t skip       = (written > LH_RING) ? lsp_min(written - LH_RING, n_ring) : 0;
+            latency_sample_t *rv    = &ring[skip];
+            n_ring                 -= skip;
+
+            v->begin_object("sLatency", &sLatency, sizeof(latency_t));
+            {
+                v->write("nConfig", sLatency.nConfig);
+                v->write("nHead", head);
+                v->write("nCalls", sLatency.nCalls);
+                v->write("nOverruns", sLatency.nOverruns);
+                v->write("fMaxLoad", sLatency.fMaxLoad);
+                v->write("fLoad50", latency_percentile(bins, 0.5f));
+                v->write("fLoad99", latency_percentile(bins, 0.99f));
+                v->write("fLoad999", latency_percentile(bins, 0.999f));
+                v->writev("vBins", bins, LH_BINS);
+                v->begin_array("vRing", rv, n_ring);
+                {
+                    for (size_t i=0; i<n_ring; ++i)
+                    {
+                        v->begin_object(&rv[i], sizeof(latency_sample_t));
+                        {
+                            v->write("fLoad", rv[i].fLoad);
+                            v->write("nConfig", rv[i].nConfig);
+                        }
+                        v->end_object();
+                    }
+                }
+                v->end_array();
+            }
+            v->end_object();
+        #endif /* LSP_TIMING */
         }
 
     } /* namespace plugins */
@@ -22,13 +22,18 @@
 #include <private/plugins/graph_equalizer.h>
 #include <lsp-plug.in/plug-fw/ui.h>
 #include <lsp-plug.in/dsp-units/units.h>
+#include <lsp-plug.in/runtime/system.h>
 #include <lsp-plug.in/stdlib/locale.h>
+#include <lsp-plug.in/stdlib/math.h>
 #include <lsp-plug.in/stdlib/stdio.h>
 #include <lsp-plug.in/stdlib/string.h>
 
 #include <private/meta/graph_equalizer.h>
 #include <private/ui/graph_equalizer.h>
 
+#define GAIN_STEPS_PER_DB       100.0f
+#define GAIN_STEP_NONE          ssize_t(-0x7fffffff)
+
 namespace lsp
 {
     namespace plugui
@@ -75,22 +80,47 @@ namespace lsp
             NULL
         };
 
+        static const char *lbl_strings[] =
+        {
+            "labels.filter",
+            NULL
+        };
+
+        static const char *lbl_strings_lr[] =
+        {
+            "labels.chan.left",
+            "labels.chan.right",
+            NULL
+        };
+
+        static const char *lbl_strings_ms[] =
+        {
+            "labels.chan.mid",
+            "labels.chan.side",
+            NULL
+        };
+
         //---------------------------------------------------------------------
         graph_equalizer_ui::graph_equalizer_ui(const meta::plugin_t *meta): ui::Module(meta)
         {
             fmtStrings      = fmt_strings;
+            lblStrings      = lbl_strings;
             nFilters        = 16;
             pCurrFilter     = NULL;
+            pHoverFilter    = NULL;
+            pInfoFilter     = NULL;
 
             if ((!strcmp(meta->uid, meta::graph_equalizer_x16_lr.uid)) ||
                 (!strcmp(meta->uid, meta::graph_equalizer_x32_lr.uid)))
             {
                 fmtStrings      = fmt_strings_lr;
+                lblStrings      = lbl_strings_lr;
             }
             else if ((!strcmp(meta->uid, meta::graph_equalizer_x16_ms.uid)) ||
                  (!strcmp(meta->uid, meta::graph_equalizer_x32_ms.uid)))
             {
                 fmtStrings      = fmt_strings_ms;
+                lblStrings      = lbl_strings_ms;
             }
 
 
@@ -112,6 +142,10 @@ namespace lsp
             if (res != STATUS_OK)
                 return res;
 
+        #ifdef LSP_TRACE
+            system::time_millis_t init_time = system::get_time_millis();
+        #endif /* LSP_TRACE */
+
             // Find main filter grids
             pWrapper->controller()->widgets()->query_group("filters", &vFilterGrids);
             for (size_t i=0, n=vFilterGrids.size(); i<n; ++i)
@@ -125,33 +159,57 @@ namespace lsp
 
             add_filters();
 
+            lsp_trace("Filters initialized in %d ms", int(system::get_time_millis() - init_time));
+
             return STATUS_OK;
         }
 
         status_t graph_equalizer_ui::pre_destroy()
         {
+            for (size_t i=0, n=vFilters.size(); i<n; ++i)
+            {
+                filter_t *f = vFilters.uget(i);
+                if (f == NULL)
+                    continue;
+
+                if (f->pWidgets != NULL)
+                {
+                    delete f->pWidgets;
+                    f->pWidgets = NULL;
+                }
+            }
+
+            vFilterIndex.flush();
+            sInfoLabel.truncate();
+            pCurrFilter     = NULL;
+            pHoverFilter    = NULL;
+            pInfoFilter     = NULL;
+
             return ui::Module::pre_destroy();
         }
 
         template <class T>
-        T *graph_equalizer_ui::find_filter_widget(const char *fmt, const char *base, size_t id)
+        T *graph_equalizer_ui::find_filter_widget(const char *base, const filter_t *f)
         {
             char widget_id[64];
-            ::snprintf(widget_id, sizeof(widget_id)/sizeof(char), fmt, base, int(id));
+            ::snprintf(widget_id, sizeof(widget_id)/sizeof(char), "%s%s", base, f->sSuffix);
             return pWrapper->controller()->widgets()->get<T>(widget_id);
         }
 
-        ui::IPort *graph_equalizer_ui::find_port(const char *fmt, const char *base, size_t id)
+        ui::IPort *graph_equalizer_ui::find_port(const char *base, const filter_t *f)
         {
             char port_id[32];
-            ::snprintf(port_id, sizeof(port_id)/sizeof(char), fmt, base, int(id));
+            ::snprintf(port_id, sizeof(port_id)/sizeof(char), "%s%s", base, f->sSuffix);
             return pWrapper->port(port_id);
         }
 
         void graph_equalizer_ui::add_filters()
         {
+            // Resolve only ports and widgets that require binding, other ones
+            // are resolved on demand by resolve_filter() and query_filter_group()
             size_t step = 32/nFilters;
-            for (const char **fmt = fmtStrings; *fmt != NULL; ++fmt)
+            const char **lbl = lblStrings;
+            for (const char **fmt = fmtStrings; *fmt != NULL; ++fmt, ++lbl)
             {
                 for (size_t port_id=0; port_id<nFilters; ++port_id)
                 {
@@ -165,60 +223,89 @@ namespace lsp
                     f.sRect.nHeight = 0;
 
                     f.bMouseIn      = false;
+                    f.bResolved     = false;
+                    f.bGroup        = false;
+                    ::snprintf(f.sSuffix, sizeof(f.sSuffix)/sizeof(char), *fmt, "", int(port_id));
 
-                    f.wMarker       = find_filter_widget<tk::GraphMarker>(*fmt, "filter_marker", port_id);
-                    f.wDot          = find_filter_widget<tk::GraphDot>(*fmt, "filter_dot", port_id);
-                    f.wInfo         = find_filter_widget<tk::GraphText>(*fmt, "filter_info", port_id);
+                    f.fFreq         = meta::graph_equalizer_metadata::band_frequencies[port_id*step];
+                    f.nGainStep     = GAIN_STEP_NONE;
+                    f.sLabelKey     = *lbl;
 
-                    f.wGain         = find_filter_widget<tk::Knob>(*fmt, "filter_gain", port_id);
-                    f.wGrid         = find_filter_grid(&f);
+                    f.pGain         = NULL;
+                    f.pOn           = NULL;
+                    f.pMute         = NULL;
+                    f.pVisible      = NULL;
 
-                    f.fFreq         = meta::graph_equalizer_metadata::band_frequencies[port_id*step];
-                    f.pGain         = find_port(*fmt, "g", port_id);
-                    if (f.pGain != NULL)
-                        f.pGain->bind(this);
-                    f.pOn           = find_port(*fmt, "xe", port_id);
-                    f.pMute         = find_port(*fmt, "xm", port_id);
-                    f.pVisible      = find_port(*fmt, "fv", port_id);
-                    if (f.pVisible != NULL)
-                        f.pVisible->bind(this);
-
-                    vFilters.add(&f);
+                    f.wGrid         = NULL;
+                    f.wMarker       = NULL;
+                    f.wDot          = NULL;
+                    f.wInfo         = NULL;
+                    f.pWidgets      = NULL;
+
+                    if (!vFilters.add(&f))
+                        return;
                 }
             }
 
-            // Bind events
-            size_t index = 0;
-            for (const char **fmt = fmtStrings; *fmt != NULL; ++fmt)
+            // Bind ports and events
+            for (size_t i=0, n=vFilters.size(); i<n; ++i)
             {
-                for (size_t port_id=0; port_id<nFilters; ++port_id)
+                filter_t *f     = vFilters.uget(i);
+
+                f->pGain        = find_port("g", f);
+                if (f->pGain != NULL)
+                    f->pGain->bind(this);
+                f->pVisible     = find_port("fv", f);
+                if (f->pVisible != NULL)
+                    f->pVisible->bind(this);
+
+                f->wDot         = find_filter_widget<tk::GraphDot>("filter_dot", f);
+                if (f->wDot != NULL)
                 {
-                    filter_t *f = vFilters.uget(index++);
-                    if (f == NULL)
-                        return;
+                    f->wDot->slots()->bind(tk::SLOT_MOUSE_IN, slot_filter_mouse_in, f);
+                    f->wDot->slots()->bind(tk::SLOT_MOUSE_OUT, slot_filter_mouse_out, f);
+                }
+            }
+        }
 
-                    if (f->wDot != NULL)
-                    {
-                        f->wDot->slots()->bind(tk::SLOT_MOUSE_IN, slot_filter_mouse_in, f);
-                        f->wDot->slots()->bind(tk::SLOT_MOUSE_OUT, slot_filter_mouse_out, f);
-                    }
+        void graph_equalizer_ui::resolve_filter(filter_t *f)
+        {
+            if (f->bResolved)
+                return;
 
-                    // Get all filter-related widgets
-                    LSPString grp_name;
-                    grp_name.fmt_utf8(*fmt, "grp_filter", int(port_id));
-                    lltl::parray<tk::Widget> all_widgets;
-                    pWrapper->controller()->widgets()->query_group(&grp_name, &all_widgets);
-                    for (size_t i=0, n=all_widgets.size(); i<n; ++i)
-                    {
-                        tk::Widget *w = all_widgets.uget(i);
-                        if (w != NULL)
-                        {
-                            w->slots()->bind(tk::SLOT_MOUSE_IN, slot_filter_mouse_in, f);
-                            w->slots()->bind(tk::SLOT_MOUSE_OUT, slot_filter_mouse_out, f);
-                        }
-                    }
+            f->wMarker      = find_filter_widget<tk::GraphMarker>("filter_marker", f);
+            f->wInfo        = find_filter_widget<tk::GraphText>("filter_info", f);
+            f->pOn          = find_port("xe", f);
+            f->pMute        = find_port("xm", f);
+            f->bResolved    = true;
+        }
+
+        void graph_equalizer_ui::query_filter_group(filter_t *f)
+        {
+            if (f->bGroup)
+                return;
+            f->bGroup       = true;
+
+            f->pWidgets     = new lltl::parray<tk::Widget>();
+            if (f->pWidgets == NULL)
+                return;
+
+            // Get all filter-related widgets
+            char grp_name[32];
+            ::snprintf(grp_name, sizeof(grp_name)/sizeof(char), "grp_filter%s", f->sSuffix);
+            pWrapper->controller()->widgets()->query_group(grp_name, f->pWidgets);
+
+            for (size_t i=0, n=f->pWidgets->size(); i<n; ++i)
+            {
+                tk::Widget *w = f->pWidgets->uget(i);
+                if (w != NULL)
+                {
+                    w->slots()->bind(tk::SLOT_MOUSE_IN, slot_filter_mouse_in, f);
+                    w->slots()->bind(tk::SLOT_MOUSE_OUT, slot_filter_mouse_out, f);
                 }
             }
+
+            f->wGrid        = find_filter_grid(f);
         }
 
         void graph_equalizer_ui::update_filter_info_text()
@@ -229,94 +316,118 @@ namespace lsp
             if (f != NULL && f->pVisible != NULL && f->pVisible->value() < 0.5f)
                 f = NULL;
 
-            // Commit current filter pointer and update note text
-            for (size_t i=0, n=vFilters.size(); i<n; ++i)
+            // Check that we have the widget to display
+            float freq = -1.0f, gain = -1.0f;
+            if (f != NULL)
+            {
+                // Get the frequency, the gain and check that filter is enabled
+                freq        = f->fFreq;
+                gain        = (f->pGain != NULL) ? f->pGain->value() : -1.0f;
+                bool on     = (f->pOn != NULL) ? (f->pOn->value() >= 0.5f) : false;
+
+                if ((f->wInfo == NULL) || (freq < 0.0f) || (gain < 0.0f) || (!on))
+                    f = NULL;
+            }
+
+            // Commit current filter pointer, touch only widgets that change their visibility
+            if (pInfoFilter != f)
             {
-                filter_t *xf = vFilters.uget(i);
-                if (xf != NULL)
+                if (pInfoFilter != NULL)
+                    show_filter_info(pInfoFilter, false);
+                if (f != NULL)
                 {
-                    xf->wInfo->visibility()->set(xf == f);
-                    xf->wMarker->visibility()->set(xf == f);
+                    // Re-format the label when shown again, the language may have changed meanwhile
+                    show_filter_info(f, true);
+                    format_filter_label(&sInfoLabel, f);
+                    f->nGainStep = GAIN_STEP_NONE;
                 }
+                pInfoFilter = f;
             }
-
-            // Check that we have the widget to display
-            if ((f == NULL) || (f->wInfo == NULL))
+            if (f == NULL)
                 return;
 
-            // Get the frequency
-            float freq = f->fFreq;
-            if (freq < 0.0f)
-            {
-                f->wInfo->visibility()->set(false);
-                f->wMarker->visibility()->set(false);
+            // Update the text only if the displayed gain value has changed
+            const float gain_db = dspu::gain_to_db(gain);
+            const ssize_t gain_step = ssize_t(roundf(gain_db * GAIN_STEPS_PER_DB));
+            if (f->nGainStep == gain_step)
                 return;
-            }
 
-            // Get the gain
-            float gain = (f->pGain != NULL) ? f->pGain->value() : -1.0f;
-            if (gain < 0.0f)
-            {
-                f->wInfo->visibility()->set(false);
-                f->wMarker->visibility()->set(false);
-                return;
-            }
+            f->nGainStep = gain_step;
 
-            // Check that filter is enabled
-            bool on = (f->pOn != NULL) ? (f->pOn->value() >= 0.5f) : false;
-            if (!on)
-            {
-                f->wInfo->visibility()->set(false);
-                f->wMarker->visibility()->set(false);
-                return;
-            }
+            // Fill the parameters
+            expr::Parameters params;
+            params.set_float("frequency", freq);
+            params.set_float("gain", gain_db);
+            params.set_string("filter", &sInfoLabel);
+
+            f->wInfo->text()->set("lists.graph_eq.filter_info", &params);
+        }
 
-            // Update the info displayed in the text
+        void graph_equalizer_ui::format_filter_label(LSPString *dst, filter_t *f)
+        {
+            // Format the localized label of the filter with the current dictionary
+            tk::prop::String lc_string;
+            lc_string.bind(f->wInfo->style(), display()->dictionary());
+            SET_LOCALE_SCOPED(LC_NUMERIC, "C");
+            lc_string.set(f->sLabelKey);
+            lc_string.format(dst);
+            lc_string.params()->clear();
+        }
+
+        void graph_equalizer_ui::show_filter_info(filter_t *f, bool visible)
+        {
+            if (f->wInfo != NULL)
+                f->wInfo->visibility()->set(visible);
+            if (f->wMarker != NULL)
+                f->wMarker->visibility()->set(visible);
+        }
+
+        size_t graph_equalizer_ui::find_filter_index(const tk::Widget *grid, ssize_t x)
+        {
+            // Find the first filter in the index which key (grid, left) is greater than (grid, x)
+            const uintptr_t key = uintptr_t(grid);
+            size_t first = 0, last = vFilterIndex.size();
+            while (first < last)
             {
-                // Fill the parameters
-                expr::Parameters params;
-                tk::prop::String lc_string;
-                LSPString text;
-                lc_string.bind(f->wInfo->style(), display()->dictionary());
-                SET_LOCALE_SCOPED(LC_NUMERIC, "C");
-
-                // Frequency
-                params.set_float("frequency", freq);
-
-                // Gain
-                params.set_float("gain", dspu::gain_to_db(gain));
-
-                // Filter number and audio channel
-                text.set_ascii(f->pGain->id());
-                if (text.starts_with_ascii("gm_"))
-                    lc_string.set("labels.chan.mid");
-                else if (text.starts_with_ascii("gs_"))
-                    lc_string.set("labels.chan.side");
-                else if (text.starts_with_ascii("gl_"))
-                    lc_string.set("labels.chan.left");
-                else if (text.starts_with_ascii("gr_"))
-                    lc_string.set("labels.chan.right");
-                else
-                    lc_string.set("labels.filter");
-                lc_string.format(&text);
-                params.set_string("filter", &text);
-                lc_string.params()->clear();
+                size_t middle       = (first + last) >> 1;
+                const filter_t *f   = vFilterIndex.uget(middle);
+                const uintptr_t fk  = uintptr_t(f->wGrid);
 
-                f->wInfo->text()->set("lists.graph_eq.filter_info", &params);
+                if ((fk < key) || ((fk == key) && (f->sRect.nLeft <= x)))
+                    first       = middle + 1;
+                else
+                    last        = middle;
             }
+
+            return first;
         }
 
-        graph_equalizer_ui::filter_t *graph_equalizer_ui::find_filter_by_rect(tk::Widget *grid, ssize_t x, ssize_t y)
+        void graph_equalizer_ui::build_filter_index()
         {
+            vFilterIndex.clear();
             for (size_t i=0, n=vFilters.size(); i<n; ++i)
             {
-                filter_t *d = vFilters.uget(i);
-                if (d->wGrid != grid)
+                filter_t *f = vFilters.uget(i);
+                if ((f == NULL) || (f->wGrid == NULL))
                     continue;
-                if (tk::Position::inside(&d->sRect, x, y))
-                    return d;
+                if (!vFilterIndex.insert(find_filter_index(f->wGrid, f->sRect.nLeft), f))
+                    return;
             }
-            return NULL;
+        }
+
+        graph_equalizer_ui::filter_t *graph_equalizer_ui::find_filter_by_rect(tk::Widget *grid, ssize_t x, ssize_t y)
+        {
+            // The filter columns do not overlap, so the only candidate is the rightmost
+            // filter of the grid which starts to the left of the pointer
+            size_t index = find_filter_index(grid, x);
+            if (index <= 0)
+                return NULL;
+
+            filter_t *d = vFilterIndex.uget(index - 1);
+            if (d->wGrid != grid)
+                return NULL;
+
+            return (tk::Position::inside(&d->sRect, x, y)) ? d : NULL;
         }
 
         void graph_equalizer_ui::on_main_grid_mouse_in(tk::Widget *w, ssize_t x, ssize_t y)
@@ -336,6 +447,9 @@ namespace lsp
         void graph_equalizer_ui::on_main_grid_mouse_move(tk::Widget *w, ssize_t x, ssize_t y)
         {
             filter_t *f = find_filter_by_rect(w, x, y);
+            if (f == pHoverFilter)
+                return;
+
             if (f != NULL)
                 on_filter_mouse_in(f);
             else
@@ -344,65 +458,63 @@ namespace lsp
 
         void graph_equalizer_ui::on_main_grid_realized(tk::Widget *w)
         {
-            // Bind events
-            size_t index = 0;
-            for (const char **fmt = fmtStrings; *fmt != NULL; ++fmt)
+            for (size_t i=0, n=vFilters.size(); i<n; ++i)
             {
-                for (size_t port_id=0; port_id<nFilters; ++port_id)
+                filter_t *f = vFilters.uget(i);
+                if (f == NULL)
+                    continue;
+
+                // Query filter widgets once, the list is kept for further realizations
+                query_filter_group(f);
+                if ((f->wGrid != w) || (f->pWidgets == NULL))
+                    continue;
+
+                // Estimate the surrounding rectangle size
+                ws::rectangle_t r;
+                ssize_t min_x = 0, max_x = 0;
+                ssize_t min_y = 0, max_y = 0;
+                size_t processed = 0;
+                for (size_t j=0, m=f->pWidgets->size(); j<m; ++j)
                 {
-                    filter_t *f = vFilters.uget(index++);
-                    if ((f == NULL) || (f->wGrid != w))
-                        continue;
-
-                    // Get all filter-related widgets
-                    LSPString grp_name;
-                    grp_name.fmt_utf8(*fmt, "grp_filter", int(port_id));
-                    lltl::parray<tk::Widget> all_widgets;
-                    pWrapper->controller()->widgets()->query_group(&grp_name, &all_widgets);
-
-                    // Estimate the surrounding rectangle size
-                    ws::rectangle_t r;
-                    ssize_t min_x = 0, max_x = 0;
-                    ssize_t min_y = 0, max_y = 0;
-                    size_t processed = 0;
-                    for (size_t i=0, n=all_widgets.size(); i<n; ++i)
+                    tk::Widget *fw = f->pWidgets->uget(j);
+                    if (fw != NULL)
                     {
-                        tk::Widget *w = all_widgets.uget(i);
-                        if (w != NULL)
+                        fw->get_padded_rectangle(&r);
+                        if (processed++ > 0)
+                        {
+                            min_x = lsp_min(min_x, r.nLeft);
+                            min_y = lsp_min(min_y, r.nTop);
+                            max_x = lsp_max(max_x, r.nLeft + r.nWidth);
+                            max_y = lsp_max(max_y, r.nTop + r.nHeight);
+                        }
+                        else
                         {
-                            w->get_padded_rectangle(&r);
-                            if (processed++ > 0)
-                            {
-                                min_x = lsp_min(min_x, r.nLeft);
-                                min_y = lsp_min(min_y, r.nTop);
-                                max_x = lsp_max(max_x, r.nLeft + r.nWidth);
-                                max_y = lsp_max(max_y, r.nTop + r.nHeight);
-                            }
-                            else
-                            {
-                                min_x = r.nLeft;
-                                min_y = r.nTop;
-                                max_x = r.nLeft + r.nWidth;
-                                max_y = r.nTop + r.nHeight;
-                            }
+                            min_x = r.nLeft;
+                            min_y = r.nTop;
+                            max_x = r.nLeft + r.nWidth;
+                            max_y = r.nTop + r.nHeight;
                         }
                     }
-
-                    // Update allocation rectangle
-                    f->sRect.nLeft      = min_x;
-                    f->sRect.nTop       = min_y;
-                    f->sRect.nWidth     = max_x - min_x;
-                    f->sRect.nHeight    = max_y - min_y;
                 }
+
+                // Update allocation rectangle
+                f->sRect.nLeft      = min_x;
+                f->sRect.nTop       = min_y;
+                f->sRect.nWidth     = max_x - min_x;
+                f->sRect.nHeight    = max_y - min_y;
             }
+
+            // Rebuild the index for lookup
+            build_filter_index();
         }
 
         void graph_equalizer_ui::notify(ui::IPort *port, size_t flags)
         {
-            if (pCurrFilter != NULL)
+            filter_t *f = pHoverFilter;
+            if ((f != NULL) && ((f->pVisible == port) || (f->pGain == port)))
             {
-                if (pCurrFilter->pVisible == port || pCurrFilter->pGain == port)
-                    update_filter_info_text();
+                pCurrFilter   = (f->pMute->value() >= 0.5f) ? NULL : f;
+                update_filter_info_text();
             }
         }
 
@@ -489,6 +601,11 @@ namespace lsp
 
         void graph_equalizer_ui::on_filter_mouse_in(filter_t *f)
         {
+            resolve_filter(f);
+            if ((pHoverFilter != NULL) && (pHoverFilter != f))
+                pHoverFilter->bMouseIn  = false;
+
+            pHoverFilter  = f;
             pCurrFilter   = (f->pMute->value() >= 0.5) ? NULL : f;
             f->bMouseIn = true;
             update_filter_info_text();
@@ -496,33 +613,33 @@ namespace lsp
 
         void graph_equalizer_ui::on_filter_mouse_out()
         {
-            pCurrFilter = NULL;
-            for (size_t i=0, n=vFilters.size(); i<n; ++i)
+            if (pHoverFilter != NULL)
             {
-                filter_t *f = vFilters.uget(i);
-                if (f != NULL)
-                    f->bMouseIn = false;
+                pHoverFilter->bMouseIn  = false;
+                pHoverFilter            = NULL;
             }
+
+            pCurrFilter = NULL;
             update_filter_info_text();
         }
 
         tk::Widget *graph_equalizer_ui::find_filter_grid(filter_t *f)
         {
-            tk::Widget *list[] =
-            {
-                f->wGain
-            };
+            // All widgets of the filter group are placed into the same grid
+            if (f->pWidgets == NULL)
+                return NULL;
+
+            tk::Widget *w = NULL;
+            for (size_t i=0, n=f->pWidgets->size(); (i<n) && (w == NULL); ++i)
+                w = f->pWidgets->uget(i);
+            if (w == NULL)
+                return NULL;
 
             for (size_t i=0, n=vFilterGrids.size(); i<n; ++i)
             {
                 tk::Widget *g = vFilterGrids.uget(i);
-
-                for (size_t j=0, m=sizeof(list)/sizeof(list[0]); j<m; ++j)
-                {
-                    tk::Widget *w = list[j];
-                    if ((w != NULL) && (w->has_parent(g)))
-                        return g;
-                }
+                if (w->has_parent(g))
+                    return g;
             }
 
             return NULL;